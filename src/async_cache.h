@@ -0,0 +1,206 @@
+#pragma once
+
+// 协程版 cache 访问接口，需要 C++20
+//  async_get: 分片锁被占用时不阻塞线程，挂起协程并在 executor 上重试
+//  get_or_load: 未命中时调用异步 loader 回源，同一 key 同时只有一个 loader 在执行，
+//               其余请求挂起等待
+//
+// executor: 调用方所在的 executor，协程挂起后在这里恢复
+//  loader 完成后 leader 先切回自己的 executor，再写入 cache；等待者各自在自己的 executor 上恢复
+//  不传时使用构造 AsyncCache 时给定的默认 executor
+//
+// CACHE 需提供:
+//  int try_get(const KEY& key, VALUE& value); // 0 - 命中; 1 - 不存在; -1 - 锁竞争
+//  int try_put(const KEY& key, const VALUE& value); // 0 - 写入; 1 - 未写入; -1 - 锁竞争
+//
+// LOADER 签名: Task<VALUE>(const KEY& key)
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "executor.h"
+#include "task.h"
+
+namespace griyn {
+
+template <typename KEY, typename VALUE, typename CACHE>
+class AsyncCache {
+public:
+    AsyncCache(CACHE& cache, Executor& executor) :
+        _cache(cache), _executor(executor) {}
+
+    // return: 命中时返回 value，否则为空
+    Task<std::optional<VALUE>> async_get(KEY key, Executor* executor = nullptr);
+
+    // 命中直接返回，未命中由 loader 加载并写入 cache
+    // loader 抛出的异常会传给所有等待该 key 的请求
+    template <typename LOADER>
+    Task<VALUE> get_or_load(KEY key, LOADER loader, Executor* executor = nullptr);
+
+    CACHE& cache() { return _cache; }
+    Executor& executor() { return _executor; }
+
+private:
+    // 一次正在进行的加载，等待者和各自的 executor 挂在 waiters 上
+    struct Flight {
+        bool done {false};
+        std::optional<VALUE> value;
+        std::exception_ptr error;
+        std::vector<std::pair<std::coroutine_handle<>, Executor*>> waiters;
+    };
+
+    struct FlightAwaiter {
+        // flight 由等待方协程帧中的 shared_ptr 保活，这里只持有裸指针
+        AsyncCache& self;
+        Flight* flight;
+        Executor* executor;
+
+        bool await_ready() const noexcept { return false; }
+        // return: false - 加载已完成，不挂起
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> guard(self._flight_mutex);
+            if (flight->done) {
+                return false;
+            }
+            flight->waiters.emplace_back(handle, executor);
+            return true;
+        }
+        VALUE await_resume() {
+            if (flight->error) {
+                std::rethrow_exception(flight->error);
+            }
+            return *flight->value;
+        }
+    };
+
+    // leader 执行加载并写入 cache
+    template <typename LOADER>
+    Task<VALUE> load(KEY key, LOADER& loader, Executor* executor);
+
+    // 结束加载，在各自的 executor 上唤醒等待者
+    void finish(const KEY& key, const std::shared_ptr<Flight>& flight);
+
+private:
+    CACHE& _cache;
+    Executor& _executor;
+
+    std::mutex _flight_mutex;
+    std::unordered_map<KEY, std::shared_ptr<Flight>> _flights;
+};
+
+////// IMPLEMENT //////
+template <typename KEY, typename VALUE, typename CACHE>
+Task<std::optional<VALUE>> AsyncCache<KEY, VALUE, CACHE>::async_get(
+        KEY key, Executor* executor) {
+    Executor& ex = executor != nullptr ? *executor : _executor;
+    VALUE value;
+    while (true) {
+        int ret = _cache.try_get(key, value);
+        if (ret == 0) {
+            co_return value;
+        }
+        if (ret == 1) {
+            co_return std::nullopt;
+        }
+        // 锁竞争，让出线程，稍后在 executor 上重试
+        co_await ex.schedule();
+    }
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+template <typename LOADER>
+Task<VALUE> AsyncCache<KEY, VALUE, CACHE>::get_or_load(
+        KEY key, LOADER loader, Executor* executor) {
+    if (executor == nullptr) {
+        executor = &_executor;
+    }
+
+    std::optional<VALUE> cached = co_await async_get(key, executor);
+    if (cached) {
+        co_return std::move(*cached);
+    }
+
+    std::shared_ptr<Flight> flight;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> guard(_flight_mutex);
+        auto it = _flights.find(key);
+        if (it == _flights.end()) {
+            flight = std::make_shared<Flight>();
+            _flights.emplace(key, flight);
+            leader = true;
+        } else {
+            flight = it->second;
+        }
+    }
+
+    if (!leader) {
+        VALUE value = co_await FlightAwaiter{*this, flight.get(), executor};
+        co_return value;
+    }
+
+    try {
+        flight->value = co_await load(key, loader, executor);
+    } catch (...) {
+        flight->error = std::current_exception();
+    }
+    finish(key, flight);
+
+    if (flight->error) {
+        std::rethrow_exception(flight->error);
+    }
+    co_return *flight->value;
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+template <typename LOADER>
+Task<VALUE> AsyncCache<KEY, VALUE, CACHE>::load(
+        KEY key, LOADER& loader, Executor* executor) {
+    // 上一个 leader 可能在本次未命中之后、登记 flight 之前刚写入 cache，再查一次避免重复加载
+    std::optional<VALUE> cached = co_await async_get(key, executor);
+    if (cached) {
+        co_return std::move(*cached);
+    }
+
+    std::optional<VALUE> loaded;
+    std::exception_ptr error;
+    try {
+        loaded = co_await loader(key);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    // loader 可能在 IO 线程上完成，无论成败都先切回调用方的 executor
+    co_await executor->schedule();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    while (_cache.try_put(key, *loaded) < 0) {
+        co_await executor->schedule();
+    }
+    co_return std::move(*loaded);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+void AsyncCache<KEY, VALUE, CACHE>::finish(
+        const KEY& key, const std::shared_ptr<Flight>& flight) {
+    std::vector<std::pair<std::coroutine_handle<>, Executor*>> waiters;
+    {
+        std::lock_guard<std::mutex> guard(_flight_mutex);
+        flight->done = true;
+        waiters.swap(flight->waiters);
+        _flights.erase(key);
+    }
+
+    for (auto& waiter : waiters) {
+        std::coroutine_handle<> handle = waiter.first;
+        waiter.second->post([handle] { handle.resume(); });
+    }
+}
+
+} // griyn
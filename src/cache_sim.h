@@ -0,0 +1,268 @@
+#pragma once
+
+// 轨迹回放，tool/cache_sim 的实现，拆成头文件便于测试
+//
+// 回放规则:
+//  轨迹先按 timestamp_us 稳定排序，再按时间顺序回放
+//  GET 命中计数；未命中视为回源并写入 cache
+//  PUT 写入 cache，不计入命中率
+//  ERASE 忽略，现有策略都不支持删除
+//
+// SHARDS 采样:
+//  只保留 hash(key) % P < T 的记录，采样率 R = T / P
+//  回放容量按 capacity * R 缩放，命中率近似等于全量回放的结果
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "trace_recorder.h"
+#include "lru_cache.h"
+#include "lfu_cache.h"
+#include "static_cache.h"
+
+namespace griyn {
+
+static const uint64_t SHARDS_MODULUS = 1 << 24;
+
+struct SimOptions {
+    std::string path;
+    std::vector<uint64_t> capacities;
+    std::vector<uint32_t> ttls {1, 5, 30, 60, 300};
+    uint64_t min_cap {1000};
+    uint64_t max_cap {10000000};
+    uint32_t steps {16};
+    double sample {1.0};
+    uint32_t threads {std::max(1u, std::thread::hardware_concurrency())};
+};
+
+struct SimJob {
+    std::string policy; // lru / lfu / fifo / expire
+    uint64_t param; // 容量，或 expire 的 ttl 秒数
+    uint64_t gets {0};
+    uint64_t misses {0};
+    double avg_size {0}; // expire 的平均驻留 key 数(已按采样率还原)
+};
+
+// 解析命令行，argv[1] 为轨迹路径
+// return: false - 参数非法
+bool parse_sim_options(int argc, char** argv, SimOptions& options);
+
+// 读取轨迹，按采样率过滤后按时间排序
+// return: 文件中的总记录数
+uint64_t load_trace(TraceReader& reader, double sample, std::vector<TraceRecord>& trace);
+
+// 按 job.policy 回放，结果写入 job
+void run_sim_job(const std::vector<TraceRecord>& trace, double sample, SimJob& job);
+
+////// IMPLEMENT //////
+namespace sim_detail {
+
+// key_hash 已是哈希值，再混淆一次避免与 std::hash 的恒等实现冲突
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb3f99ca6b5fdULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline std::vector<uint64_t> split(const std::string& str) {
+    std::vector<uint64_t> values;
+    size_t start = 0;
+    while (start < str.size()) {
+        size_t end = str.find(',', start);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+        values.push_back(strtoull(str.substr(start, end - start).c_str(), nullptr, 10));
+        start = end + 1;
+    }
+    return values;
+}
+
+// 回放时的容量，至少为 1；parse_sim_options 保证不超过 INT_MAX
+inline int scaled_capacity(uint64_t capacity, double sample) {
+    return std::max<int64_t>(1, (int64_t)(capacity * sample + 0.5));
+}
+
+template <typename CACHE, typename GET, typename PUT>
+void replay(const std::vector<TraceRecord>& trace,
+        CACHE& cache, GET get, PUT put, SimJob& job) {
+    uint32_t value = 0;
+    for (const auto& record : trace) {
+        if (record.op == TRACE_GET) {
+            ++job.gets;
+            if (!get(cache, record.key_hash, value)) {
+                ++job.misses;
+                put(cache, record.key_hash, record.size);
+            }
+        } else if (record.op == TRACE_PUT) {
+            put(cache, record.key_hash, record.size);
+        }
+    }
+}
+
+// 模拟 ExpireCache 的语义：写入后 ttl 秒过期，已存在的 key 不更新
+// 依赖轨迹按时间排序，timed_queue 只从队首出队
+inline void replay_expire(const std::vector<TraceRecord>& trace,
+        double sample, SimJob& job) {
+    uint64_t ttl_us = job.param * 1000000;
+    std::unordered_map<uint64_t, uint64_t> table; // key -> 写入时间
+    std::deque<std::pair<uint64_t, uint64_t>> timed_queue;
+    double size_sum = 0;
+
+    auto expire = [&](uint64_t now) {
+        while (!timed_queue.empty() && timed_queue.front().first + ttl_us <= now) {
+            table.erase(timed_queue.front().second);
+            timed_queue.pop_front();
+        }
+    };
+    auto put = [&](uint64_t key, uint64_t now) {
+        if (table.emplace(key, now).second) {
+            timed_queue.emplace_back(now, key);
+        }
+    };
+
+    for (const auto& record : trace) {
+        expire(record.timestamp_us);
+        if (record.op == TRACE_GET) {
+            ++job.gets;
+            size_sum += table.size();
+            if (table.find(record.key_hash) == table.end()) {
+                ++job.misses;
+                put(record.key_hash, record.timestamp_us);
+            }
+        } else if (record.op == TRACE_PUT) {
+            put(record.key_hash, record.timestamp_us);
+        }
+    }
+
+    job.avg_size = job.gets == 0 ? 0 : size_sum / job.gets / sample;
+}
+
+} // sim_detail
+
+inline bool parse_sim_options(int argc, char** argv, SimOptions& options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.path = argv[1];
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            return false;
+        }
+        std::string name = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+
+        if (name == "capacities") {
+            options.capacities = sim_detail::split(value);
+        } else if (name == "ttls") {
+            options.ttls.clear();
+            for (uint64_t ttl : sim_detail::split(value)) {
+                options.ttls.push_back(ttl);
+            }
+        } else if (name == "min" || name == "max") {
+            // strtoull 会把负数转成很大的正数，先按有符号解析
+            long long cap = strtoll(value.c_str(), nullptr, 10);
+            if (cap < 1) {
+                return false;
+            }
+            (name == "min" ? options.min_cap : options.max_cap) = cap;
+        } else if (name == "steps") {
+            long steps = strtol(value.c_str(), nullptr, 10);
+            if (steps < 1 || steps > UINT32_MAX) {
+                return false;
+            }
+            options.steps = steps;
+        } else if (name == "sample") {
+            options.sample = atof(value.c_str());
+        } else if (name == "threads") {
+            options.threads = std::max(1, atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+
+    if (options.capacities.empty()) {
+        if (options.min_cap > options.max_cap) {
+            return false;
+        }
+        // 按倍数取点，曲线在对数坐标上均匀
+        double ratio = options.steps > 1 ?
+            pow((double)options.max_cap / options.min_cap, 1.0 / (options.steps - 1)) : 1;
+        double cap = options.min_cap;
+        for (uint32_t i = 0; i < options.steps; ++i) {
+            options.capacities.push_back((uint64_t)(cap + 0.5));
+            cap *= ratio;
+        }
+    }
+
+    // LRUCache / LFUCache 的容量是 int
+    for (uint64_t capacity : options.capacities) {
+        if (capacity > INT_MAX) {
+            return false;
+        }
+    }
+
+    return options.sample > 0 && options.sample <= 1;
+}
+
+inline uint64_t load_trace(TraceReader& reader, double sample, std::vector<TraceRecord>& trace) {
+    uint64_t threshold = (uint64_t)(sample * SHARDS_MODULUS);
+    uint64_t total = 0;
+    TraceRecord record;
+    while (reader.next(record)) {
+        ++total;
+        if (sim_detail::mix(record.key_hash) % SHARDS_MODULUS < threshold) {
+            trace.push_back(record);
+        }
+    }
+
+    // 文件中各线程的记录按刷盘批次交错，批次之间不保证时间有序
+    std::stable_sort(trace.begin(), trace.end(),
+        [](const TraceRecord& a, const TraceRecord& b) {
+            return a.timestamp_us < b.timestamp_us;
+        });
+    return total;
+}
+
+inline void run_sim_job(const std::vector<TraceRecord>& trace, double sample, SimJob& job) {
+    using sim_detail::replay;
+    using sim_detail::scaled_capacity;
+
+    if (job.policy == "lru") {
+        LRUCache<uint64_t, uint32_t> cache(scaled_capacity(job.param, sample));
+        replay(trace, cache,
+            [](LRUCache<uint64_t, uint32_t>& c, uint64_t k, uint32_t& v) { return c.get(k, v); },
+            [](LRUCache<uint64_t, uint32_t>& c, uint64_t k, uint32_t v) { c.put(k, v); },
+            job);
+    } else if (job.policy == "lfu") {
+        LFUCache<uint64_t, uint32_t> cache(scaled_capacity(job.param, sample));
+        replay(trace, cache,
+            [](LFUCache<uint64_t, uint32_t>& c, uint64_t k, uint32_t& v) { return c.get(k, v); },
+            [](LFUCache<uint64_t, uint32_t>& c, uint64_t k, uint32_t v) { c.set(k, v); },
+            job);
+    } else if (job.policy == "fifo") {
+        StaticCache<uint64_t, uint32_t> cache(scaled_capacity(job.param, sample));
+        replay(trace, cache,
+            [](StaticCache<uint64_t, uint32_t>& c, uint64_t k, uint32_t& v) {
+                return c.get(k, v) == 0;
+            },
+            [](StaticCache<uint64_t, uint32_t>& c, uint64_t k, uint32_t v) { c.put(k, v); },
+            job);
+    } else if (job.policy == "expire") {
+        sim_detail::replay_expire(trace, sample, job);
+    }
+}
+
+} // griyn
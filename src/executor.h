@@ -0,0 +1,112 @@
+#pragma once
+
+// 协程调度器
+//  Executor 只负责把任务投递到某个线程执行，协程通过 co_await schedule() 切换过去
+//  LoopExecutor 是最简单的实现：任务排队，由调用 run 的线程依次执行，测试用
+
+#include <coroutine>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace griyn {
+
+class Executor {
+public:
+    virtual ~Executor() {}
+
+    // 投递任务，不要求立即执行
+    virtual void post(std::function<void()> fn) = 0;
+
+    // co_await executor.schedule() 挂起当前协程，并在该 executor 上恢复
+    struct ScheduleAwaiter {
+        Executor& executor;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            executor.post([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{*this}; }
+};
+
+class LoopExecutor : public Executor {
+public:
+    void post(std::function<void()> fn) override;
+
+    // 执行队列中的任务，直到队列为空
+    // return: 执行的任务数
+    uint64_t run();
+
+    // 执行任务直到 stop 被调用，队列为空时阻塞等待
+    void run_forever();
+
+    void stop();
+
+private:
+    // 取一个任务，wait 为 true 时队列为空会阻塞
+    // return: true - 取到任务; false - 队列为空或已停止
+    bool pop(std::function<void()>& fn, bool wait);
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::deque<std::function<void()>> _queue;
+    bool _stopped {false};
+};
+
+////// IMPLEMENT //////
+inline void LoopExecutor::post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        _queue.push_back(std::move(fn));
+    }
+    _cond.notify_one();
+}
+
+inline uint64_t LoopExecutor::run() {
+    uint64_t count = 0;
+    std::function<void()> fn;
+    while (pop(fn, false)) {
+        fn();
+        ++count;
+    }
+    return count;
+}
+
+inline void LoopExecutor::run_forever() {
+    std::function<void()> fn;
+    while (pop(fn, true)) {
+        fn();
+    }
+}
+
+inline void LoopExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        _stopped = true;
+    }
+    _cond.notify_all();
+}
+
+inline bool LoopExecutor::pop(std::function<void()>& fn, bool wait) {
+    std::unique_lock<std::mutex> guard(_mutex);
+    if (wait) {
+        _cond.wait(guard, [this] { return _stopped || !_queue.empty(); });
+        if (_stopped) {
+            return false;
+        }
+    }
+    if (_queue.empty()) {
+        return false;
+    }
+
+    fn = std::move(_queue.front());
+    _queue.pop_front();
+    return true;
+}
+
+} // griyn
@@ -1,6 +1,12 @@
+#pragma once
+
 #include <unordered_map>
 #include <thread>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
 #include "timed_queue.h"
 #include "shard_table.h"
 
@@ -12,11 +18,8 @@ public:
     ExpireCache(
             uint32_t ttl_s, uint64_t capacity = -1, // TODO:keep_size 
             uint32_t timer_interval_s = 1,
-            uint32_t shard_num = 1) :
-        _ttl_s(ttl_s), _cap(capacity), 
-        _timer_interval_s(timer_interval_s), 
-        _table(shard_num), _running(true),
-        _expire_timer(&ExpireCache<KEY, VALUE>::timer_work, this) {}
+            uint32_t shard_num = 1,
+            const NumaOption<KEY>& numa_option = NumaOption<KEY>());
 
     ~ExpireCache();
 
@@ -29,13 +32,31 @@ public:
     //  true - 查找成功，value 有值；false - 查找失败，value 未被赋值
     bool get(const KEY& key, VALUE& value);
 
+    // 非阻塞查找，分片锁被占用时立即返回
+    // return: 0 - 查找成功; 1 - key不存在; -1 - 锁竞争，未查找
+    int try_get(const KEY& key, VALUE& value);
+
+    // 非阻塞添加，分片锁被占用时立即返回
+    // 时间队列的锁只在入队和定时清理时短暂持有，这里仍直接加锁
+    // return: 0 - 添加成功; 1 - key 重复; -1 - 锁竞争，未添加
+    int try_put(const KEY& key, const VALUE& value);
+
     uint64_t size();
 
+    // 开启 NUMA 时每个 node 的命中和跨 node 访问统计
+    std::vector<NumaStat> numa_stats() const { return _table.numa_stats(); }
+
+    // 设置过期回调，定时清理时对每个退场的 key 调用一次
+    // 用于向 FrontCache 等上层缓存广播失效
+    void set_expire_listener(std::function<void(const KEY&)> listener);
+
     // 需要遍历竞争较大，debug用
     uint64_t timeq_size();	
 
 private:
-    void timer_work();
+    // 清理第 node 个 node 上的过期数据
+    // 开启 NUMA 时线程先绑定到该 node，再构造该 node 的时间队列，队列节点从本 node 分配
+    void timer_work(int node);
     void pop_front();
 
 private:
@@ -43,16 +64,49 @@ private:
     uint64_t _cap;
     uint32_t _timer_interval_s;
 
-    std::thread _expire_timer;
-    bool _running;
+    bool _numa;
 
     ShardTable<KEY, VALUE> _table;
 	
     // 将 1s 内的 key 保存在一个 node 里，定期清理(timer_interval)
-    TimedQueue<KEY> _timed_queue;
+    // 每个 NUMA node 一个队列，只记录该 node 分片上的 key；未开启 NUMA 时只有一个
+    std::vector<std::unique_ptr<TimedQueue<KEY>>> _timed_queues;
+
+    std::mutex _listener_lock;
+    std::function<void(const KEY&)> _expire_listener;
+
+    // 保护 _running 和 _ready_timers，析构时唤醒清理线程，不必等满一个间隔
+    std::mutex _timer_lock;
+    std::condition_variable _timer_cond;
+    bool _running;
+    int _ready_timers;
+
+    // 在构造函数体中启动，保证线程启动时其余成员已构造完成
+    std::vector<std::thread> _expire_timers;
 };
 
 ////// IMPLEMENT //////
+template <typename KEY, typename VALUE>
+ExpireCache<KEY, VALUE>::ExpireCache(
+        uint32_t ttl_s, uint64_t capacity,
+        uint32_t timer_interval_s,
+        uint32_t shard_num,
+        const NumaOption<KEY>& numa_option) :
+        _ttl_s(ttl_s), _cap(capacity),
+        _timer_interval_s(timer_interval_s),
+        _numa(numa_option.enable),
+        _table(shard_num, numa_option),
+        _running(true), _ready_timers(0) {
+    _timed_queues.resize(_table.node_num());
+    for (int node = 0; node < _table.node_num(); ++node) {
+        _expire_timers.emplace_back(&ExpireCache<KEY, VALUE>::timer_work, this, node);
+    }
+
+    // 时间队列由各清理线程构造，全部就绪后才能 put
+    std::unique_lock<std::mutex> guard(_timer_lock);
+    _timer_cond.wait(guard, [this] { return _ready_timers == _table.node_num(); });
+}
+
 template <typename KEY, typename VALUE>
 bool ExpireCache<KEY, VALUE>::put(const KEY& key, const VALUE& value) {
     // 不能允许添加重复 key
@@ -62,7 +116,7 @@ bool ExpireCache<KEY, VALUE>::put(const KEY& key, const VALUE& value) {
         return false;
     }
 
-    _timed_queue.put(key); // 保证时间队列 key 不重复
+    _timed_queues[_table.node_of(key)]->put(key); // 保证时间队列 key 不重复
 
     return true;
 }
@@ -73,26 +127,69 @@ bool ExpireCache<KEY, VALUE>::get(const KEY& key, VALUE& value) {
 }
 
 template <typename KEY, typename VALUE>
-void ExpireCache<KEY, VALUE>::timer_work() {
-    std::this_thread::sleep_for(std::chrono::seconds(_timer_interval_s));
+int ExpireCache<KEY, VALUE>::try_get(const KEY& key, VALUE& value) {
+    return _table.try_get(key, value);
+}
+
+template <typename KEY, typename VALUE>
+int ExpireCache<KEY, VALUE>::try_put(const KEY& key, const VALUE& value) {
+    int ret = _table.try_put(key, value);
+    if (ret == 0) {
+        _timed_queues[_table.node_of(key)]->put(key);
+    }
+    return ret;
+}
+
+template <typename KEY, typename VALUE>
+void ExpireCache<KEY, VALUE>::timer_work(int node) {
+    if (_numa) {
+        // 绑定失败时仍照常清理，只是内存不保证在本 node
+        Numa::bind_thread(Numa::nodes()[node]);
+    }
+
+    std::unique_ptr<TimedQueue<KEY>> timed_queue(new TimedQueue<KEY>());
+    TimedQueue<KEY>& queue = *timed_queue;
+    {
+        std::lock_guard<std::mutex> guard(_timer_lock);
+        _timed_queues[node] = std::move(timed_queue);
+        ++_ready_timers;
+    }
+    _timer_cond.notify_all();
+
+    auto interval = std::chrono::seconds(_timer_interval_s);
+    auto deadline = std::chrono::steady_clock::now() + interval;
 
-    while (_running) {
-        uint32_t start = now_s();
+    std::unique_lock<std::mutex> guard(_timer_lock);
+    while (!_timer_cond.wait_until(guard, deadline, [this] { return !_running; })) {
+        guard.unlock();
+        deadline = std::chrono::steady_clock::now() + interval;
 
-        std::vector<KEY> expired_keys = _timed_queue.pop(_ttl_s);
+        std::vector<KEY> expired_keys = queue.pop(_ttl_s);
         _table.batch_erase(expired_keys);
 
-        uint32_t end = now_s();
+        {
+            std::lock_guard<std::mutex> listener_guard(_listener_lock);
+            if (_expire_listener) {
+                for (const auto& key : expired_keys) {
+                    _expire_listener(key);
+                }
+            }
+        }
 
-        std::this_thread::sleep_for(
-                std::chrono::seconds(_timer_interval_s - (end - start)));
+        guard.lock();
     }
 }
 
 template <typename KEY, typename VALUE>
 ExpireCache<KEY, VALUE>::~ExpireCache() {
-    _running = false;
-    _expire_timer.join();
+    {
+        std::lock_guard<std::mutex> guard(_timer_lock);
+        _running = false;
+    }
+    _timer_cond.notify_all();
+    for (auto& timer : _expire_timers) {
+        timer.join();
+    }
 }
 
 template <typename KEY, typename VALUE>
@@ -100,9 +197,20 @@ uint64_t ExpireCache<KEY, VALUE>::size() {
     return _table.size();
 }
 
+template <typename KEY, typename VALUE>
+void ExpireCache<KEY, VALUE>::set_expire_listener(
+        std::function<void(const KEY&)> listener) {
+    std::lock_guard<std::mutex> guard(_listener_lock);
+    _expire_listener = std::move(listener);
+}
+
 template <typename KEY, typename VALUE>
 uint64_t ExpireCache<KEY, VALUE>::timeq_size() {
-    return _timed_queue.size();
+    uint64_t size = 0;
+    for (auto& timed_queue : _timed_queues) {
+        size += timed_queue->size();
+    }
+    return size;
 }
 
 } // griyn
@@ -0,0 +1,283 @@
+#pragma once
+
+// 线程本地前置缓存(L1)
+//  挂在任意共享 cache 前面，热点 key 命中时不加锁、不访问共享 cache
+//  每个线程持有一个小的直接映射表，互相之间不共享
+//  命中时只读取两个共享原子量：epoch 和 key 所在的版本号槽
+//  二者读多写少，且各占独立的 cache line，无关 key 的 put 不会干扰热点 key 的读取
+//
+// 一致性：有界过期 + 版本号失效
+//  - key 按哈希落在 _versions 的一个槽上，put/invalidate 时槽版本号 +1
+//  - L1 条目记录填充时读到的槽版本号，版本不一致即视为失效
+//  - 条目存活超过 max_stale_s 强制回源，兜底未广播的变更
+//
+// 限制：直接作用在共享层上的变更不会广播到 L1
+//  包括绕过 FrontCache 的 put/erase、LRUCache 的淘汰
+//  这些变更最多延迟 max_stale_s 秒可见；需要更快可见时由调用方 invalidate
+//  ExpireCache 的过期可通过 set_expire_listener 挂接 invalidate
+//  max_stale_s 设为 0 会关闭兜底，仅在所有变更都广播时使用
+//
+// CACHE 需提供:
+//  bool get(const KEY& key, VALUE& value);
+//  put(const KEY& key, const VALUE& value);
+//  erase(const KEY& key); // 仅在调用 FrontCache::erase 时需要
+
+#include <atomic>
+#include <functional> // std::hash
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "util.h"
+
+namespace griyn {
+
+template <typename KEY, typename VALUE, typename CACHE>
+class FrontCache {
+public:
+    // local_size: 每个线程 L1 的槽数，向上取 2 的幂
+    // version_slots: 版本号槽数，越大误失效越少，向上取 2 的幂，每槽占一个 cache line
+    // max_stale_s: L1 条目最长存活时间，见上方限制说明
+    FrontCache(CACHE& cache,
+            uint32_t local_size = 1024,
+            uint32_t version_slots = 1024,
+            uint32_t max_stale_s = 1);
+
+    // 释放所有线程中属于本实例的 L1
+    ~FrontCache();
+
+    // 先查本线程 L1，未命中再查共享 cache 并回填
+    // return: true - 成功，value填入对应值; false - 失败，value保留原值
+    bool get(const KEY& key, VALUE& value);
+
+    // 写共享 cache，并使所有线程中该 key 的 L1 条目失效
+    // return: 共享 cache put 的返回值
+    auto put(const KEY& key, const VALUE& value)
+            -> decltype(std::declval<CACHE&>().put(key, value));
+
+    // 删除共享 cache 中的 key，并使所有线程中该 key 的 L1 条目失效
+    void erase(const KEY& key);
+
+    // 共享层发生删除/过期时调用，广播失效
+    void invalidate(const KEY& key);
+
+    // 全部失效，用于共享层被整体清理的场景
+    void invalidate_all();
+
+    CACHE& shared() { return _cache; }
+
+private:
+    struct Slot {
+        KEY key;
+        VALUE value;
+        uint64_t version {0};
+        uint32_t fill_time_s {0};
+        bool valid {false};
+    };
+
+    // 单个线程的 L1，只被所属线程读写，无需加锁
+    // 线程和实例共同持有：线程退出时释放；实例析构时清空 slots 并标记 alive = false，
+    // 线程下次注册新 L1 时顺带移除
+    struct LocalTable {
+        uint64_t epoch {0};
+        std::vector<Slot> slots;
+        std::atomic<bool> alive {true};
+    };
+
+    // 版本号独占 cache line，避免无关 key 的 put 使热点 key 所在的行失效
+    struct alignas(64) Version {
+        std::atomic<uint64_t> value {0};
+    };
+
+    // 先改共享层再递增版本，保证其他线程回填时不会留下旧值
+    // 析构时失效，共享层操作抛异常时同样生效
+    struct Invalidator {
+        FrontCache* self;
+        const KEY& key;
+        ~Invalidator() { self->invalidate(key); }
+    };
+
+    // 本线程的 L1，命中上次访问的实例时不查 map
+    LocalTable& local_table();
+
+    // 在本线程的 map 中查找或注册 L1
+    LocalTable& register_local_table();
+
+    uint64_t version_of(size_t hash) const;
+
+    static uint32_t round_pow2(uint32_t n);
+
+private:
+    CACHE& _cache;
+    uint32_t _local_mask;
+    uint32_t _version_mask;
+    uint32_t _max_stale_s;
+
+    // 实例 id 区分同一线程内的多个 FrontCache，避免析构后地址复用拿到旧 L1
+    uint64_t _id;
+
+    // invalidate_all 时递增，各线程 L1 发现 epoch 变化后整体清空
+    alignas(64) std::atomic<uint64_t> _epoch;
+
+    std::unique_ptr<Version[]> _versions;
+
+    // 各线程的 L1，析构时统一清空
+    std::mutex _tables_mutex;
+    std::vector<std::weak_ptr<LocalTable>> _tables;
+};
+
+////// IMPLEMENT //////
+template <typename KEY, typename VALUE, typename CACHE>
+FrontCache<KEY, VALUE, CACHE>::FrontCache(CACHE& cache,
+        uint32_t local_size, uint32_t version_slots, uint32_t max_stale_s) :
+        _cache(cache),
+        _local_mask(round_pow2(local_size) - 1),
+        _version_mask(round_pow2(version_slots) - 1),
+        _max_stale_s(max_stale_s),
+        _epoch(0),
+        _versions(new Version[_version_mask + 1]) {
+    static std::atomic<uint64_t> s_next_id(0);
+    _id = s_next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+FrontCache<KEY, VALUE, CACHE>::~FrontCache() {
+    std::lock_guard<std::mutex> guard(_tables_mutex);
+    for (auto& weak_table : _tables) {
+        std::shared_ptr<LocalTable> table = weak_table.lock();
+        if (table) {
+            // 析构时不应再有线程访问本实例，这里直接释放缓存的 value
+            std::vector<Slot>().swap(table->slots);
+            table->alive.store(false, std::memory_order_release);
+        }
+    }
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+bool FrontCache<KEY, VALUE, CACHE>::get(const KEY& key, VALUE& value) {
+    LocalTable& local = local_table();
+    size_t hash = std::hash<KEY>()(key);
+    Slot& slot = local.slots[hash & _local_mask];
+
+    // 版本号要在读共享 cache 之前取
+    // 这样读取期间发生的 put 一定会让本次回填的条目失效
+    uint64_t version = version_of(hash);
+
+    if (slot.valid && slot.version == version && slot.key == key) {
+        if (_max_stale_s == 0 || slot.fill_time_s + _max_stale_s > now_s()) {
+            value = slot.value;
+            return true;
+        }
+    }
+
+    if (!_cache.get(key, value)) {
+        return false;
+    }
+
+    slot.key = key;
+    slot.value = value;
+    slot.version = version;
+    slot.fill_time_s = _max_stale_s == 0 ? 0 : now_s();
+    slot.valid = true;
+
+    return true;
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+auto FrontCache<KEY, VALUE, CACHE>::put(const KEY& key, const VALUE& value)
+        -> decltype(std::declval<CACHE&>().put(key, value)) {
+    Invalidator invalidator {this, key};
+    return _cache.put(key, value);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+void FrontCache<KEY, VALUE, CACHE>::erase(const KEY& key) {
+    Invalidator invalidator {this, key};
+    _cache.erase(key);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+void FrontCache<KEY, VALUE, CACHE>::invalidate(const KEY& key) {
+    size_t hash = std::hash<KEY>()(key);
+    _versions[hash & _version_mask].value.fetch_add(1, std::memory_order_release);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+void FrontCache<KEY, VALUE, CACHE>::invalidate_all() {
+    _epoch.fetch_add(1, std::memory_order_release);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+typename FrontCache<KEY, VALUE, CACHE>::LocalTable&
+FrontCache<KEY, VALUE, CACHE>::local_table() {
+    // 多数线程只访问一个实例，先比较上次访问的实例，命中路径上不查 map
+    thread_local uint64_t t_last_id = UINT64_MAX;
+    thread_local LocalTable* t_last = nullptr;
+
+    if (t_last_id != _id) {
+        t_last = &register_local_table();
+        t_last_id = _id;
+    }
+
+    LocalTable& local = *t_last;
+    uint64_t epoch = _epoch.load(std::memory_order_acquire);
+    if (local.slots.empty() || local.epoch != epoch) {
+        local.slots.assign(_local_mask + 1, Slot());
+        local.epoch = epoch;
+    }
+
+    return local;
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+typename FrontCache<KEY, VALUE, CACHE>::LocalTable&
+FrontCache<KEY, VALUE, CACHE>::register_local_table() {
+    // 每个线程按实例 id 保存自己的 L1
+    thread_local std::unordered_map<uint64_t, std::shared_ptr<LocalTable>> t_tables;
+
+    auto it = t_tables.find(_id);
+    if (it != t_tables.end()) {
+        return *it->second;
+    }
+
+    // 首次访问本实例，顺带移除已析构实例留下的空 L1
+    for (auto iter = t_tables.begin(); iter != t_tables.end();) {
+        if (!iter->second->alive.load(std::memory_order_acquire)) {
+            iter = t_tables.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    std::shared_ptr<LocalTable> table = std::make_shared<LocalTable>();
+    {
+        std::lock_guard<std::mutex> guard(_tables_mutex);
+        // 移除已退出线程的 L1，避免线程频繁创建时列表增长
+        for (auto iter = _tables.begin(); iter != _tables.end();) {
+            if (iter->expired()) {
+                iter = _tables.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        _tables.push_back(table);
+    }
+
+    return *t_tables.emplace(_id, std::move(table)).first->second;
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+uint64_t FrontCache<KEY, VALUE, CACHE>::version_of(size_t hash) const {
+    return _versions[hash & _version_mask].value.load(std::memory_order_acquire);
+}
+
+template <typename KEY, typename VALUE, typename CACHE>
+uint32_t FrontCache<KEY, VALUE, CACHE>::round_pow2(uint32_t n) {
+    uint32_t size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // griyn
@@ -27,6 +27,42 @@ public:
         return true;
     }
 
+    // 非阻塞查找，锁被占用时立即返回
+    // return: 0 - 成功，value填入对应值; 1 - key不存在; -1 - 锁竞争，未查找
+    int try_get(const KEY& key, VALUE& value) {
+        std::unique_lock<std::mutex> guard(_mutex, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            return -1;
+        }
+        auto it = _index.find(key);
+        if (it == _index.end()) {
+            return 1;
+        }
+        move_front(it->second);
+        value = it->second->second;
+        return 0;
+    }
+
+    // 非阻塞添加或更新，锁被占用时立即返回
+    // return: 0 - 成功; -1 - 锁竞争，未写入
+    int try_put(const KEY& key, const VALUE& value) {
+        std::unique_lock<std::mutex> guard(_mutex, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            return -1;
+        }
+        auto it = _index.find(key);
+        if (it != _index.end()) {
+            move_front(it->second);
+            _time_queue.begin()->second = value;
+            return 0;
+        }
+        if (_index.size() >= _cap) {
+            pop_back();
+        }
+        put_front(key, value);
+        return 0;
+    }
+
     void put(const KEY& key, const VALUE& value) {
         std::lock_guard<std::mutex> guard(_mutex);
         auto it = _index.find(key);
@@ -0,0 +1,307 @@
+#pragma once
+
+// NUMA 相关的封装
+//  定义 CACHE_WITH_NUMA 并链接 -lnuma 时生效，否则视为只有一个 node，内存走普通 new
+//  Numa: 可用 node 列表、当前线程所在 node、绑核、按 node 分配内存
+//   node id 可能不连续(如 0, 2)，也可能存在没有 cpu 的 node，
+//   按序号使用时通过 nodes()[i] 取实际 id
+//  NumaPool: 单个 node 上的内存池，供 Table 的哈希表节点和桶数组使用
+//  NumaAllocator: 从 NumaPool 分配的 STL 分配器
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#ifdef CACHE_WITH_NUMA
+#include <numa.h>
+#include <sched.h>
+#endif
+
+namespace griyn {
+
+class Numa {
+public:
+    // 系统是否支持 NUMA，进程内只检测一次
+    static bool available();
+
+    // 有 cpu 且允许本进程分配内存的 node id，升序，进程内只枚举一次
+    // 未启用 NUMA 时为 {0}
+    static const std::vector<int>& nodes();
+
+    // nodes() 的大小，未启用 NUMA 时为 1
+    static int node_num();
+
+    // 当前线程所在的 node id，线程内缓存，每隔一段时间刷新一次
+    static int current_node();
+
+    // 把当前线程绑定到 node 的 cpu 上，并优先从该 node 分配内存
+    // return: true - 成功; false - 绑定失败，线程保持原有的 cpu 和内存策略
+    static bool bind_thread(int node);
+
+    // 在 node 上分配内存，按页分配，适合大块内存
+    // node < 0 时使用普通 new
+    static void* alloc(size_t size, int node);
+    static void free(void* ptr, size_t size, int node);
+};
+
+// 非线程安全，由持有者的锁保护
+class NumaPool {
+public:
+    explicit NumaPool(int node) : _node(node) {}
+    ~NumaPool();
+
+    NumaPool(const NumaPool&) = delete;
+    NumaPool& operator=(const NumaPool&) = delete;
+
+    void* alloc(size_t size);
+    void free(void* ptr, size_t size);
+
+    int node() const { return _node; }
+
+private:
+    // 大小分级:
+    //  不超过 MAX_SMALL 按 ALIGN 递增，超过后按 2 的幂递增到 MAX_POOLED
+    //  都从 CHUNK_SIZE 大小的 chunk 中切分，只有超过 MAX_POOLED 的请求(如桶数组)直接按页分配
+    static const size_t ALIGN = 16;
+    static const size_t MAX_SMALL = 256;
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t MAX_POOLED = CHUNK_SIZE / 4;
+    static const size_t SMALL_CLASS_NUM = MAX_SMALL / ALIGN;
+    static const size_t CLASS_NUM = SMALL_CLASS_NUM + 6; // 512 ... 16K
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static size_t size_class(size_t size) {
+        if (size <= MAX_SMALL) {
+            return size == 0 ? 0 : (size + ALIGN - 1) / ALIGN - 1;
+        }
+        size_t cls = SMALL_CLASS_NUM;
+        for (size_t block_size = MAX_SMALL * 2; block_size < size; block_size <<= 1) {
+            ++cls;
+        }
+        return cls;
+    }
+
+    static size_t class_size(size_t cls) {
+        return cls < SMALL_CLASS_NUM ?
+            (cls + 1) * ALIGN : MAX_SMALL << (cls - SMALL_CLASS_NUM + 1);
+    }
+
+    // 换 chunk 前把剩余的零头按能放下的最大分级挂到空闲链表
+    void recycle_tail();
+
+private:
+    int _node;
+    FreeBlock* _free_lists[CLASS_NUM] = {};
+    std::vector<char*> _chunks;
+    char* _cur {nullptr};
+    size_t _left {0};
+};
+
+template <typename T>
+class NumaAllocator {
+public:
+    typedef T value_type;
+
+    // pool 为空时使用普通 new
+    explicit NumaAllocator(NumaPool* pool = nullptr) : _pool(pool) {}
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U>& other) : _pool(other.pool()) {}
+
+    T* allocate(size_t n) {
+        if (_pool == nullptr) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(_pool->alloc(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        if (_pool == nullptr) {
+            ::operator delete(ptr);
+            return;
+        }
+        _pool->free(ptr, n * sizeof(T));
+    }
+
+    NumaPool* pool() const { return _pool; }
+
+    template <typename U>
+    bool operator==(const NumaAllocator<U>& other) const { return _pool == other.pool(); }
+    template <typename U>
+    bool operator!=(const NumaAllocator<U>& other) const { return _pool != other.pool(); }
+
+private:
+    NumaPool* _pool;
+};
+
+////// IMPLEMENT //////
+inline bool Numa::available() {
+#ifdef CACHE_WITH_NUMA
+    static bool s_available = numa_available() >= 0;
+    return s_available;
+#else
+    return false;
+#endif
+}
+
+inline const std::vector<int>& Numa::nodes() {
+    static const std::vector<int> s_nodes = [] {
+        std::vector<int> nodes;
+#ifdef CACHE_WITH_NUMA
+        if (available()) {
+            struct bitmask* cpus = numa_allocate_cpumask();
+            for (int node = 0; node <= numa_max_node(); ++node) {
+                if (!numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+                    continue;
+                }
+                // 没有 cpu 的 node(如纯内存扩展)无法绑定线程，跳过
+                if (numa_node_to_cpus(node, cpus) == 0 && numa_bitmask_weight(cpus) > 0) {
+                    nodes.push_back(node);
+                }
+            }
+            numa_free_cpumask(cpus);
+        }
+#endif
+        if (nodes.empty()) {
+            nodes.push_back(0);
+        }
+        return nodes;
+    }();
+    return s_nodes;
+}
+
+inline int Numa::node_num() {
+    static int s_node_num = nodes().size();
+    return s_node_num;
+}
+
+inline int Numa::current_node() {
+#ifdef CACHE_WITH_NUMA
+    // 线程可能被调度到其他 cpu，定期重新获取
+    thread_local int t_node = -1;
+    thread_local uint32_t t_count = 0;
+    if (t_node < 0 || (++t_count & 1023) == 0) {
+        int cpu = sched_getcpu();
+        t_node = (cpu < 0 || node_num() == 1) ? nodes()[0] : numa_node_of_cpu(cpu);
+        if (t_node < 0) {
+            t_node = nodes()[0];
+        }
+    }
+    return t_node;
+#else
+    return 0;
+#endif
+}
+
+inline bool Numa::bind_thread(int node) {
+#ifdef CACHE_WITH_NUMA
+    if (node < 0 || !available()) {
+        return false;
+    }
+    if (node_num() == 1) {
+        return true; // 单 node 无需绑定，保留调用方设置的亲和性
+    }
+    if (numa_run_on_node(node) != 0) {
+        return false;
+    }
+    numa_set_preferred(node);
+    return true;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+inline void* Numa::alloc(size_t size, int node) {
+#ifdef CACHE_WITH_NUMA
+    if (node >= 0 && available()) {
+        void* ptr = numa_alloc_onnode(size, node);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+#endif
+    (void)node;
+    return ::operator new(size);
+}
+
+inline void Numa::free(void* ptr, size_t size, int node) {
+#ifdef CACHE_WITH_NUMA
+    if (node >= 0 && available()) {
+        numa_free(ptr, size);
+        return;
+    }
+#endif
+    (void)size;
+    (void)node;
+    ::operator delete(ptr);
+}
+
+inline NumaPool::~NumaPool() {
+    for (char* chunk : _chunks) {
+        Numa::free(chunk, CHUNK_SIZE, _node);
+    }
+}
+
+inline void* NumaPool::alloc(size_t size) {
+    if (size > MAX_POOLED) {
+        return Numa::alloc(size, _node);
+    }
+
+    size_t cls = size_class(size);
+    if (_free_lists[cls] != nullptr) {
+        FreeBlock* block = _free_lists[cls];
+        _free_lists[cls] = block->next;
+        return block;
+    }
+
+    size_t block_size = class_size(cls);
+    if (_left < block_size) {
+        recycle_tail();
+        _cur = static_cast<char*>(Numa::alloc(CHUNK_SIZE, _node));
+        _chunks.push_back(_cur);
+        _left = CHUNK_SIZE;
+    }
+
+    void* ptr = _cur;
+    _cur += block_size;
+    _left -= block_size;
+    return ptr;
+}
+
+inline void NumaPool::free(void* ptr, size_t size) {
+    if (size > MAX_POOLED) {
+        Numa::free(ptr, size, _node);
+        return;
+    }
+
+    // 只回收到空闲链表，池析构时整体释放
+    size_t cls = size_class(size);
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = _free_lists[cls];
+    _free_lists[cls] = block;
+}
+
+inline void NumaPool::recycle_tail() {
+    // 每种分级最多挂一块，剩余不足 ALIGN 的部分丢弃
+    size_t cls = CLASS_NUM;
+    while (_left >= ALIGN && cls > 0) {
+        --cls;
+        size_t block_size = class_size(cls);
+        if (_left < block_size) {
+            continue;
+        }
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(_cur);
+        block->next = _free_lists[cls];
+        _free_lists[cls] = block;
+        _cur += block_size;
+        _left -= block_size;
+    }
+}
+
+} // griyn
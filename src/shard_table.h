@@ -1,14 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
 #include <functional> // std::hash
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
 #include <vector>
+#include "numa_util.h"
 #include "table.h"
 
 // 分片化的哈希存储结构
 // 通过分片减少读写竞争
 
+// NUMA 分片选项
+//  开启后分片轮流绑定到各 node：分片 i 属于第 i % node_num 个 node，即 Numa::nodes()[i % node_num]
+//  分片对象和其中的数据都从所属 node 分配
+//  下文的 node 均指序号(Numa::nodes() 的下标)，不是系统中的 node id
+template <typename KEY>
+struct NumaOption {
+    bool enable {false};
+
+    // key 所属的 node，返回值对 node 数取模
+    // 按 socket 划分 key 空间时，由业务线程所在 node 决定 key，就能只访问本地分片
+    // 为空时按哈希分配，只保证内存本地化
+    std::function<int(const KEY&)> partitioner;
+};
+
+// 单个 node 的访问统计
+struct NumaStat {
+    uint64_t hits {0};
+    uint64_t misses {0};
+    uint64_t local_access {0};  // 访问线程与分片在同一 node
+    uint64_t remote_access {0}; // 跨 node 访问
+};
+
 template <typename KEY, typename VALUE>
 class ShardTable {
 public:
     ShardTable(int32_t shard_num);
+    ShardTable(int32_t shard_num, const NumaOption<KEY>& numa_option);
+    ~ShardTable();
 
     // 添加kv
     // return: true - 成功; false - 失败，key重复
@@ -18,6 +51,14 @@ public:
     // return: true - 成功，value填入对应值; false - 失败，value保留原值
     bool get(const KEY& key, VALUE& value);
 
+    // 非阻塞查找，锁被占用时立即返回，供协程接口使用
+    // return: 0 - 成功，value填入对应值; 1 - key不存在; -1 - 锁竞争，未查找
+    int try_get(const KEY& key, VALUE& value);
+
+    // 非阻塞添加，锁被占用时立即返回，供协程接口使用
+    // return: 0 - 成功; 1 - 失败，key重复; -1 - 锁竞争，未添加
+    int try_put(const KEY& key, const VALUE& value);
+
     // 删除kv
     void erase(const KEY& key);
 
@@ -26,32 +67,142 @@ public:
 
     uint64_t size();
 
+    // 分片绑定的 node 数，未开启 NUMA 时为 1
+    int node_num() const { return _node_num; }
+
+    // key 所在分片的 node 序号，未开启 NUMA 时为 0
+    int node_of(const KEY& key) const;
+
+    // 每个 node 的统计，按序号排列，未开启 NUMA 时为空
+    std::vector<NumaStat> numa_stats() const;
+
 private:
     // 生成分片id的方法
-    uint32_t get_shard_id(const KEY& key);
+    uint32_t get_shard_id(const KEY& key) const;
+
+    // 开启 NUMA 时记录命中和跨 node 访问
+    // hit: 1 - 命中; 0 - 未命中; -1 - 非查找操作
+    void count_access(uint32_t shard_id, int hit);
 
 private:
-    std::vector<Table<KEY, VALUE>> _shards;
+    struct TableDeleter {
+        int node; // 系统中的 node id
+        void operator()(Table<KEY, VALUE>* table) const {
+            table->~Table();
+            griyn::Numa::free(table, sizeof(Table<KEY, VALUE>), node);
+        }
+    };
+
+    struct NodeCounter {
+        std::atomic<uint64_t> hits {0};
+        std::atomic<uint64_t> misses {0};
+        std::atomic<uint64_t> local_access {0};
+        std::atomic<uint64_t> remote_access {0};
+    };
+
+    // 单个线程的计数，只有所属线程写入，numa_stats 时汇总
+    // 由访问线程分配，内存落在线程所在 node，访问路径上没有共享写
+    // 线程和实例共同持有：线程退出后计数在下次注册时并入 _retired；
+    // 实例析构时标记 alive = false，线程下次注册新计数时顺带移除
+    struct ThreadCounter {
+        std::unique_ptr<NodeCounter[]> nodes;
+        std::atomic<bool> alive {true};
+    };
+
+    ThreadCounter& thread_counter();
+
+    // 单写者计数，不需要原子的读改写
+    static void increase(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    bool _numa;
+    int _node_num;
+    std::function<int(const KEY&)> _partitioner;
+    std::vector<std::unique_ptr<Table<KEY, VALUE>, TableDeleter>> _shards;
+
+    // 实例 id 区分同一线程访问的多个 ShardTable
+    uint64_t _id;
+    mutable std::mutex _counters_mutex;
+    std::vector<std::shared_ptr<ThreadCounter>> _counters;
+    std::vector<NumaStat> _retired; // 已退出线程的计数
 };
 
 template <typename KEY, typename VALUE>
 ShardTable<KEY, VALUE>::ShardTable(int32_t shard_num) :
-        _shards(shard_num) {
+        ShardTable(shard_num, NumaOption<KEY>()) {
+}
+
+template <typename KEY, typename VALUE>
+ShardTable<KEY, VALUE>::ShardTable(int32_t shard_num, const NumaOption<KEY>& numa_option) :
+        _numa(numa_option.enable),
+        _node_num(1),
+        _partitioner(numa_option.partitioner) {
+    if (_numa) {
+        // 分片数少于 node 数时，只使用前 shard_num 个 node
+        _node_num = std::max(1, std::min<int>(griyn::Numa::node_num(), shard_num));
+        _retired.resize(_node_num);
+    }
+
+    static std::atomic<uint64_t> s_next_id(0);
+    _id = s_next_id.fetch_add(1, std::memory_order_relaxed);
+
+    _shards.reserve(shard_num);
+    for (int32_t i = 0; i < shard_num; ++i) {
+        int node = _numa ? griyn::Numa::nodes()[i % _node_num] : -1;
+        void* mem = griyn::Numa::alloc(sizeof(Table<KEY, VALUE>), node);
+        _shards.emplace_back(new (mem) Table<KEY, VALUE>(node), TableDeleter{node});
+    }
+}
+
+template <typename KEY, typename VALUE>
+ShardTable<KEY, VALUE>::~ShardTable() {
+    std::lock_guard<std::mutex> guard(_counters_mutex);
+    for (auto& counter : _counters) {
+        counter->alive.store(false, std::memory_order_release);
+    }
 }
 
 template <typename KEY, typename VALUE>
 bool ShardTable<KEY, VALUE>::put(const KEY& key, const VALUE& value) {
-    return _shards[get_shard_id(key)].put(key, value);	
+    uint32_t shard_id = get_shard_id(key);
+    count_access(shard_id, -1);
+    return _shards[shard_id]->put(key, value);
 }
 
 template <typename KEY, typename VALUE>
 bool ShardTable<KEY, VALUE>::get(const KEY& key, VALUE& value) {
-    return _shards[get_shard_id(key)].get(key, value);
+    uint32_t shard_id = get_shard_id(key);
+    bool found = _shards[shard_id]->get(key, value);
+    count_access(shard_id, found);
+    return found;
+}
+
+template <typename KEY, typename VALUE>
+int ShardTable<KEY, VALUE>::try_get(const KEY& key, VALUE& value) {
+    uint32_t shard_id = get_shard_id(key);
+    int ret = _shards[shard_id]->try_get(key, value);
+    if (ret >= 0) {
+        count_access(shard_id, ret == 0);
+    }
+    return ret;
+}
+
+template <typename KEY, typename VALUE>
+int ShardTable<KEY, VALUE>::try_put(const KEY& key, const VALUE& value) {
+    uint32_t shard_id = get_shard_id(key);
+    int ret = _shards[shard_id]->try_put(key, value);
+    if (ret >= 0) {
+        count_access(shard_id, -1);
+    }
+    return ret;
 }
 
 template <typename KEY, typename VALUE>
 void ShardTable<KEY, VALUE>::erase(const KEY& key) {
-    return _shards[get_shard_id(key)].erase(key);
+    uint32_t shard_id = get_shard_id(key);
+    count_access(shard_id, -1);
+    return _shards[shard_id]->erase(key);
 }
 
 template <typename KEY, typename VALUE>
@@ -65,7 +216,7 @@ void ShardTable<KEY, VALUE>::batch_erase(const std::vector<KEY>& keys) {
     for (size_t i = 0; i < erase_pkeys.size(); ++i) {
         const auto& pkeys = erase_pkeys[i];
         if (pkeys.size() != 0) {
-            _shards[i].batch_erase(pkeys);
+            _shards[i]->batch_erase(pkeys);
         }
     }
 }
@@ -74,13 +225,119 @@ template <typename KEY, typename VALUE>
 uint64_t ShardTable<KEY, VALUE>::size() {
     uint64_t size = 0;
     for (auto& shard : _shards) {
-        size += shard.size();
+        size += shard->size();
     }
 
     return size;
 }
 
 template <typename KEY, typename VALUE>
-uint32_t ShardTable<KEY, VALUE>::get_shard_id(const KEY& key) {
-    return std::hash<KEY>()(key) % _shards.size();	
+int ShardTable<KEY, VALUE>::node_of(const KEY& key) const {
+    return _numa ? get_shard_id(key) % _node_num : 0;
+}
+
+template <typename KEY, typename VALUE>
+std::vector<NumaStat> ShardTable<KEY, VALUE>::numa_stats() const {
+    std::vector<NumaStat> stats;
+    if (!_numa) {
+        return stats;
+    }
+
+    std::lock_guard<std::mutex> guard(_counters_mutex);
+    stats = _retired;
+    for (const auto& counter : _counters) {
+        for (int i = 0; i < _node_num; ++i) {
+            const NodeCounter& node = counter->nodes[i];
+            stats[i].hits += node.hits.load(std::memory_order_relaxed);
+            stats[i].misses += node.misses.load(std::memory_order_relaxed);
+            stats[i].local_access += node.local_access.load(std::memory_order_relaxed);
+            stats[i].remote_access += node.remote_access.load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+template <typename KEY, typename VALUE>
+uint32_t ShardTable<KEY, VALUE>::get_shard_id(const KEY& key) const {
+    size_t hash = std::hash<KEY>()(key);
+    if (!_numa) {
+        return hash % _shards.size();
+    }
+
+    // 先选 node，再在该 node 的分片(node, node + N, node + 2N ...)中按哈希选
+    size_t node_num = _node_num;
+    size_t node = _partitioner ? (uint32_t)_partitioner(key) % node_num : hash % node_num;
+    size_t node_shard_num = (_shards.size() - node + node_num - 1) / node_num;
+    return node + node_num * ((hash / node_num) % node_shard_num);
+}
+
+template <typename KEY, typename VALUE>
+void ShardTable<KEY, VALUE>::count_access(uint32_t shard_id, int hit) {
+    if (!_numa) {
+        return;
+    }
+
+    int node = shard_id % _node_num;
+    NodeCounter& counter = thread_counter().nodes[node];
+    if (hit == 1) {
+        increase(counter.hits);
+    } else if (hit == 0) {
+        increase(counter.misses);
+    }
+
+    if (griyn::Numa::current_node() == griyn::Numa::nodes()[node]) {
+        increase(counter.local_access);
+    } else {
+        increase(counter.remote_access);
+    }
+}
+
+template <typename KEY, typename VALUE>
+typename ShardTable<KEY, VALUE>::ThreadCounter& ShardTable<KEY, VALUE>::thread_counter() {
+    // 多数线程只访问一个实例，先比较上次访问的实例
+    thread_local uint64_t t_last_id = UINT64_MAX;
+    thread_local ThreadCounter* t_last = nullptr;
+    if (t_last_id == _id) {
+        return *t_last;
+    }
+
+    thread_local std::unordered_map<uint64_t, std::shared_ptr<ThreadCounter>> t_counters;
+    auto it = t_counters.find(_id);
+    if (it == t_counters.end()) {
+        // 首次访问本实例，顺带移除已析构实例留下的计数
+        for (auto iter = t_counters.begin(); iter != t_counters.end();) {
+            if (!iter->second->alive.load(std::memory_order_acquire)) {
+                iter = t_counters.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+
+        std::shared_ptr<ThreadCounter> counter = std::make_shared<ThreadCounter>();
+        counter->nodes.reset(new NodeCounter[_node_num]);
+        {
+            std::lock_guard<std::mutex> guard(_counters_mutex);
+            // 只剩实例持有的计数属于已退出的线程，并入 _retired，避免线程频繁创建时列表增长
+            for (auto iter = _counters.begin(); iter != _counters.end();) {
+                if (iter->use_count() > 1) {
+                    ++iter;
+                    continue;
+                }
+                for (int i = 0; i < _node_num; ++i) {
+                    const NodeCounter& node = (*iter)->nodes[i];
+                    _retired[i].hits += node.hits.load(std::memory_order_relaxed);
+                    _retired[i].misses += node.misses.load(std::memory_order_relaxed);
+                    _retired[i].local_access += node.local_access.load(std::memory_order_relaxed);
+                    _retired[i].remote_access += node.remote_access.load(std::memory_order_relaxed);
+                }
+                iter = _counters.erase(iter);
+            }
+            _counters.push_back(counter);
+        }
+        it = t_counters.emplace(_id, std::move(counter)).first;
+    }
+
+    t_last_id = _id;
+    t_last = it->second.get();
+    return *t_last;
 }
@@ -1,11 +1,18 @@
+#pragma once
+
 #include <unordered_map>
+#include <memory>
 #include <mutex>
+#include "numa_util.h"
 
 // 简单的有锁哈希存储
 
 template <typename KEY, typename VALUE>
 class Table {
 public:
+    // node >= 0 时哈希表节点从该 NUMA node 上分配
+    explicit Table(int node = -1);
+
     // 添加kv
     // return: true - 成功; false - 失败，key重复
     bool put(const KEY& key, const VALUE& value);
@@ -14,6 +21,14 @@ public:
     // return: true - 成功，value填入对应值; false - 失败，value保留原值
     bool get(const KEY& key, VALUE& value);
 
+    // 非阻塞查找，锁被占用时立即返回，供协程接口使用
+    // return: 0 - 成功，value填入对应值; 1 - key不存在; -1 - 锁竞争，未查找
+    int try_get(const KEY& key, VALUE& value);
+
+    // 非阻塞添加，锁被占用时立即返回，供协程接口使用
+    // return: 0 - 成功; 1 - 失败，key重复; -1 - 锁竞争，未添加
+    int try_put(const KEY& key, const VALUE& value);
+
     // 删除kv
     void erase(const KEY& key);
 
@@ -23,10 +38,19 @@ public:
     uint64_t size();
 
 private:
+    typedef griyn::NumaAllocator<std::pair<const KEY, VALUE>> Allocator;
+
     std::mutex _mutex;
-    std::unordered_map<KEY, VALUE> _table;
+    std::unique_ptr<griyn::NumaPool> _pool; // 需先于 _table 构造、晚于 _table 析构
+    std::unordered_map<KEY, VALUE, std::hash<KEY>, std::equal_to<KEY>, Allocator> _table;
 };
 
+template <typename KEY, typename VALUE>
+Table<KEY, VALUE>::Table(int node) :
+        _pool(node >= 0 ? new griyn::NumaPool(node) : nullptr),
+        _table(0, std::hash<KEY>(), std::equal_to<KEY>(), Allocator(_pool.get())) {
+}
+
 template <typename KEY, typename VALUE>
 bool Table<KEY, VALUE>::put(const KEY& key, const VALUE& value) {
     std::lock_guard<std::mutex> guard(_mutex);
@@ -46,6 +70,32 @@ bool Table<KEY, VALUE>::get(const KEY& key, VALUE& value) {
     return true;
 }
 
+template <typename KEY, typename VALUE>
+int Table<KEY, VALUE>::try_get(const KEY& key, VALUE& value) {
+    std::unique_lock<std::mutex> guard(_mutex, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        return -1;
+    }
+
+    auto it = _table.find(key);
+    if (it == _table.end()) {
+        return 1;
+    }
+
+    value = it->second;
+    return 0;
+}
+
+template <typename KEY, typename VALUE>
+int Table<KEY, VALUE>::try_put(const KEY& key, const VALUE& value) {
+    std::unique_lock<std::mutex> guard(_mutex, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        return -1;
+    }
+
+    return _table.emplace(key, value).second ? 0 : 1;
+}
+
 template <typename KEY, typename VALUE>
 void Table<KEY, VALUE>::erase(const KEY& key) {
     std::lock_guard<std::mutex> guard(_mutex);
@@ -0,0 +1,161 @@
+#pragma once
+
+// 协程返回类型
+//  Task<T> 惰性启动：创建时不执行，被 co_await 时才开始，结束后直接切回等待者
+//  spawn 把顶层 Task 投递到 executor 上执行，不关心结果的调用方使用
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "executor.h"
+
+namespace griyn {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    // 执行完毕后切回等待者，没有等待者时停在 final 点等 Task 析构
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename PROMISE>
+        std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<PROMISE> handle) noexcept {
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T v) { value.emplace(std::move(v)); }
+
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // detail
+
+template <typename T = void>
+class Task {
+public:
+    typedef detail::TaskPromise<T> promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    explicit Task(Handle handle) : _handle(handle) {}
+    Task(Task&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    struct Awaiter {
+        Handle handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) {
+            handle.promise().continuation = caller;
+            return handle;
+        }
+        T await_resume() { return handle.promise().result(); }
+    };
+
+    Awaiter operator co_await() && { return Awaiter{_handle}; }
+
+private:
+    Handle _handle;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// 顶层协程，自行启动、结束后自行销毁
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <typename T>
+Detached spawn_on(Executor& executor, Task<T> task,
+        std::function<void(T)> done) {
+    co_await executor.schedule();
+    T value = co_await std::move(task);
+    if (done) {
+        done(std::move(value));
+    }
+}
+
+inline Detached spawn_on(Executor& executor, Task<void> task,
+        std::function<void()> done) {
+    co_await executor.schedule();
+    co_await std::move(task);
+    if (done) {
+        done();
+    }
+}
+
+} // detail
+
+// 在 executor 上执行 task，完成后调用 done
+// task 抛出的异常不会被捕获，调用方应在 task 内自行处理
+template <typename T>
+void spawn(Executor& executor, Task<T> task,
+        std::type_identity_t<std::function<void(T)>> done = nullptr) {
+    detail::spawn_on(executor, std::move(task), std::move(done));
+}
+
+inline void spawn(Executor& executor, Task<void> task, std::function<void()> done = nullptr) {
+    detail::spawn_on(executor, std::move(task), std::move(done));
+}
+
+} // griyn
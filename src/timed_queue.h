@@ -78,8 +78,12 @@ void TimedQueue<T>::flush_cur_node() {
         return;
     }
 
+    // 按上一节点的 key 数预留，新节点的 keys 由调用 pop 的清理线程分配
+    // 开启 NUMA 时清理线程已绑定 node，节点内存随之落在本 node
+    size_t last_size = _cur_node->keys.size();
     _queue.push_back(std::move(_cur_node));
     _cur_node.reset(new TimeNode<T>(now_s()));
+    _cur_node->keys.reserve(last_size);
 }
 
 template<typename T>
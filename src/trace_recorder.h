@@ -0,0 +1,338 @@
+#pragma once
+
+// 访问轨迹记录，供离线回放(tool/cache_sim)调参
+//  每个线程写自己的无锁环形缓冲(单写单读)，后台线程定期刷入文件
+//  缓冲满时丢弃记录并计数，不阻塞业务线程
+//
+// 文件格式(小端):
+//  8 字节 magic "GCTRACE1"
+//  每条记录 21 字节: timestamp_us(8) key_hash(8) size(4) op(1)
+//
+// 记录顺序:
+//  每次刷盘把各线程缓冲合并为一批，批内按 timestamp_us 排序
+//  刷盘时线程仍在写入，相邻批次之间可能有少量时间逆序，需要严格有序时读取方再排序一次
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional> // std::hash
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace griyn {
+
+enum TraceOp : uint8_t {
+    TRACE_GET = 0,
+    TRACE_PUT = 1,
+    TRACE_ERASE = 2,
+};
+
+struct TraceRecord {
+    uint64_t timestamp_us;
+    uint64_t key_hash;
+    uint32_t size;
+    uint8_t op;
+};
+
+static const char TRACE_MAGIC[8] = {'G', 'C', 'T', 'R', 'A', 'C', 'E', '1'};
+static const size_t TRACE_RECORD_BYTES = 21;
+
+inline uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+}
+
+// 序列化为定长记录，按主机字节序写入，仅支持小端机器
+inline void encode_trace_record(const TraceRecord& record, char* buf) {
+    memcpy(buf, &record.timestamp_us, 8);
+    memcpy(buf + 8, &record.key_hash, 8);
+    memcpy(buf + 16, &record.size, 4);
+    memcpy(buf + 20, &record.op, 1);
+}
+
+inline void decode_trace_record(const char* buf, TraceRecord& record) {
+    memcpy(&record.timestamp_us, buf, 8);
+    memcpy(&record.key_hash, buf + 8, 8);
+    memcpy(&record.size, buf + 16, 4);
+    memcpy(&record.op, buf + 20, 1);
+}
+
+class TraceRecorder {
+public:
+    // ring_size: 每个线程的缓冲条数，向上取 2 的幂
+    // flush_interval_ms: 后台刷盘间隔
+    TraceRecorder(const std::string& path,
+            uint32_t ring_size = 65536,
+            uint32_t flush_interval_ms = 100);
+
+    ~TraceRecorder();
+
+    // 文件是否打开成功，失败时 record 直接丢弃
+    bool ok() const { return _file != nullptr; }
+
+    // 记录一次访问，只写本线程缓冲
+    // return: true - 成功; false - 缓冲已满，记录被丢弃
+    bool record(TraceOp op, uint64_t key_hash, uint32_t size = 0);
+
+    template <typename KEY>
+    bool record_key(TraceOp op, const KEY& key, uint32_t size = 0) {
+        return record(op, std::hash<KEY>()(key), size);
+    }
+
+    // 立即把所有缓冲刷入文件
+    void flush();
+
+    uint64_t recorded();
+    uint64_t dropped();
+
+private:
+    // 单写单读环形缓冲，写端为业务线程，读端为刷盘线程
+    // 线程和 recorder 共同持有：线程退出后由刷盘线程排空并移除；
+    // recorder 析构时释放 records 并标记 alive = false，线程下次注册新缓冲时顺带移除
+    struct Ring {
+        std::unique_ptr<TraceRecord[]> records;
+        uint64_t mask {0};
+        std::atomic<uint64_t> head {0}; // 写位置
+        std::atomic<uint64_t> tail {0}; // 读位置
+        std::atomic<uint64_t> dropped {0};
+        std::atomic<bool> alive {true};
+    };
+
+    Ring& local_ring();
+    void flush_work();
+    void drain(Ring& ring, std::vector<TraceRecord>& batch);
+
+private:
+    FILE* _file;
+    uint64_t _ring_size;
+    uint32_t _flush_interval_ms;
+    uint64_t _id;
+
+    std::mutex _rings_mutex; // 只保护注册和刷盘，不在 record 路径上
+    std::vector<std::shared_ptr<Ring>> _rings;
+    std::atomic<uint64_t> _recorded;
+    uint64_t _retired_dropped {0}; // 已移除缓冲的丢弃数
+
+    std::mutex _stop_mutex;
+    std::condition_variable _stop_cond;
+    bool _running;
+    std::thread _flush_thread;
+};
+
+// 顺序读取轨迹文件
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    // 文件存在且 magic 正确
+    bool ok() const { return _file != nullptr; }
+
+    // return: true - 读到一条记录; false - 文件结束
+    bool next(TraceRecord& record);
+
+private:
+    FILE* _file;
+};
+
+////// IMPLEMENT //////
+inline TraceRecorder::TraceRecorder(const std::string& path,
+        uint32_t ring_size, uint32_t flush_interval_ms) :
+        _file(fopen(path.c_str(), "wb")),
+        _ring_size(1),
+        _flush_interval_ms(flush_interval_ms),
+        _recorded(0),
+        _running(true) {
+    static std::atomic<uint64_t> s_next_id(0);
+    _id = s_next_id.fetch_add(1, std::memory_order_relaxed);
+
+    while (_ring_size < ring_size) {
+        _ring_size <<= 1;
+    }
+
+    if (_file != nullptr) {
+        fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), _file);
+    }
+    _flush_thread = std::thread(&TraceRecorder::flush_work, this);
+}
+
+inline TraceRecorder::~TraceRecorder() {
+    {
+        std::lock_guard<std::mutex> guard(_stop_mutex);
+        _running = false;
+    }
+    _stop_cond.notify_all();
+    _flush_thread.join();
+    flush();
+    if (_file != nullptr) {
+        fclose(_file);
+    }
+
+    // 析构时不应再有线程写入，直接释放仍被线程持有的缓冲
+    std::lock_guard<std::mutex> guard(_rings_mutex);
+    for (auto& ring : _rings) {
+        ring->records.reset();
+        ring->alive.store(false, std::memory_order_release);
+    }
+}
+
+inline bool TraceRecorder::record(TraceOp op, uint64_t key_hash, uint32_t size) {
+    if (_file == nullptr) {
+        return false;
+    }
+
+    Ring& ring = local_ring();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) > ring.mask) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    TraceRecord& record = ring.records[head & ring.mask];
+    record.timestamp_us = now_us();
+    record.key_hash = key_hash;
+    record.size = size;
+    record.op = op;
+    ring.head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+inline void TraceRecorder::flush() {
+    std::vector<TraceRecord> batch;
+    std::lock_guard<std::mutex> guard(_rings_mutex);
+    for (auto iter = _rings.begin(); iter != _rings.end();) {
+        // 只剩 recorder 持有的缓冲属于已退出的线程，排空后移除
+        // 先判断再排空，保证线程退出前的写入都已刷出
+        bool exited = iter->use_count() == 1;
+        drain(**iter, batch);
+        if (exited) {
+            _retired_dropped += (*iter)->dropped.load(std::memory_order_relaxed);
+            iter = _rings.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    if (_file == nullptr || batch.empty()) {
+        return;
+    }
+
+    // 各线程缓冲内部有序，合并后按时间排序
+    std::stable_sort(batch.begin(), batch.end(),
+        [](const TraceRecord& a, const TraceRecord& b) {
+            return a.timestamp_us < b.timestamp_us;
+        });
+
+    std::vector<char> buf(batch.size() * TRACE_RECORD_BYTES);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        encode_trace_record(batch[i], &buf[i * TRACE_RECORD_BYTES]);
+    }
+    fwrite(buf.data(), 1, buf.size(), _file);
+    fflush(_file);
+}
+
+inline uint64_t TraceRecorder::recorded() {
+    return _recorded.load(std::memory_order_relaxed);
+}
+
+inline uint64_t TraceRecorder::dropped() {
+    std::lock_guard<std::mutex> guard(_rings_mutex);
+    uint64_t dropped = _retired_dropped;
+    for (auto& ring : _rings) {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+inline TraceRecorder::Ring& TraceRecorder::local_ring() {
+    // 按实例 id 区分，环形缓冲同时被线程和 recorder 持有，任一方先退出都安全
+    thread_local std::unordered_map<uint64_t, std::shared_ptr<Ring>> t_rings;
+
+    auto it = t_rings.find(_id);
+    if (it == t_rings.end()) {
+        // 首次访问本实例，顺带移除已析构 recorder 留下的缓冲
+        for (auto iter = t_rings.begin(); iter != t_rings.end();) {
+            if (!iter->second->alive.load(std::memory_order_acquire)) {
+                iter = t_rings.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+
+        std::shared_ptr<Ring> ring = std::make_shared<Ring>();
+        ring->records.reset(new TraceRecord[_ring_size]);
+        ring->mask = _ring_size - 1;
+        {
+            std::lock_guard<std::mutex> guard(_rings_mutex);
+            _rings.push_back(ring);
+        }
+        it = t_rings.emplace(_id, std::move(ring)).first;
+    }
+
+    return *it->second;
+}
+
+inline void TraceRecorder::flush_work() {
+    std::unique_lock<std::mutex> guard(_stop_mutex);
+    while (_running) {
+        // 析构时被唤醒，不必等满一个间隔
+        _stop_cond.wait_for(guard, std::chrono::milliseconds(_flush_interval_ms));
+        guard.unlock();
+        flush();
+        guard.lock();
+    }
+}
+
+inline void TraceRecorder::drain(Ring& ring, std::vector<TraceRecord>& batch) {
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return;
+    }
+
+    for (uint64_t i = tail; i < head; ++i) {
+        batch.push_back(ring.records[i & ring.mask]);
+    }
+
+    ring.tail.store(head, std::memory_order_release);
+    _recorded.fetch_add(head - tail, std::memory_order_relaxed);
+}
+
+inline TraceReader::TraceReader(const std::string& path) :
+        _file(fopen(path.c_str(), "rb")) {
+    char magic[sizeof(TRACE_MAGIC)];
+    if (_file == nullptr) {
+        return;
+    }
+    if (fread(magic, 1, sizeof(magic), _file) != sizeof(magic)
+            || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0) {
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+inline TraceReader::~TraceReader() {
+    if (_file != nullptr) {
+        fclose(_file);
+    }
+}
+
+inline bool TraceReader::next(TraceRecord& record) {
+    char buf[TRACE_RECORD_BYTES];
+    if (_file == nullptr || fread(buf, 1, sizeof(buf), _file) != sizeof(buf)) {
+        return false;
+    }
+
+    decode_trace_record(buf, record);
+    return true;
+}
+
+} // griyn
@@ -0,0 +1,153 @@
+#include <string>
+#include <stdexcept>
+#include "test_tool.h"
+#include "expire_cache.h"
+#include "async_cache.h"
+
+// 前几次 try_get/try_put 模拟锁竞争
+// on_miss 在 try_get 未命中后执行一次，模拟并发请求在此期间写入
+struct BusyCache {
+    int busy_times {0};
+    int put_busy_times {0};
+    std::function<void()> on_miss;
+    std::unordered_map<int, std::string> data;
+
+    int try_get(const int& key, std::string& value) {
+        if (busy_times > 0) {
+            --busy_times;
+            return -1;
+        }
+        auto it = data.find(key);
+        if (it == data.end()) {
+            if (on_miss) {
+                auto hook = std::move(on_miss);
+                on_miss = nullptr;
+                hook();
+            }
+            return 1;
+        }
+        value = it->second;
+        return 0;
+    }
+
+    int try_put(const int& key, const std::string& value) {
+        if (put_busy_times > 0) {
+            --put_busy_times;
+            return -1;
+        }
+        data[key] = value;
+        return 0;
+    }
+
+    void put(const int& key, const std::string& value) { data[key] = value; }
+};
+
+int main() {
+    griyn::LoopExecutor executor;
+
+    // 锁竞争时挂起重试，不阻塞线程
+    BusyCache busy;
+    busy.busy_times = 2;
+    busy.put(1, "Hello");
+    griyn::AsyncCache<int, std::string, BusyCache> busy_async(busy, executor);
+
+    std::optional<std::string> output;
+    griyn::spawn(executor, busy_async.async_get(1),
+            [&](std::optional<std::string> v) { output = v; });
+    uint64_t run_count = executor.run();
+    EXPECT_EQ(run_count, 3); // 启动 + 2次重试
+    EXPECT_EQ(output.has_value(), true);
+    EXPECT_EQ(*output, "Hello");
+
+    griyn::spawn(executor, busy_async.async_get(2),
+            [&](std::optional<std::string> v) { output = v; });
+    executor.run();
+    EXPECT_EQ(output.has_value(), false);
+
+    // get_or_load: 同一 key 并发请求只加载一次
+    griyn::ExpireCache<int, std::string> cache(10);
+    griyn::AsyncCache<int, std::string, griyn::ExpireCache<int, std::string>> async(cache, executor);
+
+    int load_times = 0;
+    auto loader = [&](const int& key) -> griyn::Task<std::string> {
+        ++load_times;
+        co_await executor.schedule(); // 模拟异步 IO
+        co_return "Value" + std::to_string(key);
+    };
+
+    std::string first;
+    std::string second;
+    griyn::spawn(executor, async.get_or_load(1, loader), [&](std::string v) { first = v; });
+    griyn::spawn(executor, async.get_or_load(1, loader), [&](std::string v) { second = v; });
+    executor.run();
+    EXPECT_EQ(load_times, 1);
+    EXPECT_EQ(first, "Value1");
+    EXPECT_EQ(second, "Value1");
+
+    std::string cached;
+    EXPECT_EQ(cache.get(1, cached), true); // 已写入 cache
+    EXPECT_EQ(cached, "Value1");
+
+    griyn::spawn(executor, async.get_or_load(1, loader), [&](std::string v) { first = v; });
+    executor.run();
+    EXPECT_EQ(load_times, 1); // 命中，不再加载
+
+    // 未命中后、登记 flight 前，上一个 leader 刚写入 cache：不再重复加载
+    busy.on_miss = [&] { busy.put(3, "Loaded"); };
+    int busy_loads = 0;
+    auto busy_loader = [&](const int&) -> griyn::Task<std::string> {
+        ++busy_loads;
+        co_return "Reloaded";
+    };
+    std::string busy_output;
+    griyn::spawn(executor, busy_async.get_or_load(3, busy_loader),
+            [&](std::string v) { busy_output = v; });
+    executor.run();
+    EXPECT_EQ(busy_loads, 0);
+    EXPECT_EQ(busy_output, "Loaded");
+
+    // loader 在 IO executor 上完成，leader 和等待者都回到调用方的 executor
+    griyn::LoopExecutor io;
+    griyn::LoopExecutor caller;
+    auto io_loader = [&](const int& key) -> griyn::Task<std::string> {
+        co_await io.schedule();
+        co_return "IO" + std::to_string(key);
+    };
+    busy.put_busy_times = 2; // 写回时锁竞争，挂起重试
+    std::string io_first;
+    std::string io_second;
+    griyn::spawn(caller, busy_async.get_or_load(5, io_loader, &caller),
+            [&](std::string v) { io_first = v; });
+    griyn::spawn(caller, busy_async.get_or_load(5, io_loader, &caller),
+            [&](std::string v) { io_second = v; });
+    caller.run();
+    io.run(); // loader 完成，leader 切回 caller，此时还没有结果
+    EXPECT_EQ(io_first, "");
+    EXPECT_EQ(io_second, "");
+    EXPECT_EQ(executor.run(), 0); // 默认 executor 未被使用
+    caller.run();
+    EXPECT_EQ(io_first, "IO5");
+    EXPECT_EQ(io_second, "IO5");
+    EXPECT_EQ(busy.data[5], "IO5");
+
+    // loader 异常传给所有等待者
+    auto bad_loader = [&](const int&) -> griyn::Task<std::string> {
+        co_await executor.schedule();
+        throw std::runtime_error("load failed");
+    };
+    int errors = 0;
+    auto request = [&]() -> griyn::Task<void> {
+        try {
+            co_await async.get_or_load(2, bad_loader);
+        } catch (const std::runtime_error&) {
+            ++errors;
+        }
+    };
+    griyn::spawn(executor, request());
+    griyn::spawn(executor, request());
+    executor.run();
+    EXPECT_EQ(errors, 2);
+    EXPECT_EQ(cache.get(2, cached), false);
+
+    return 0;
+}
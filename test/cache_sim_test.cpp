@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "test_tool.h"
+#include "cache_sim.h"
+
+static bool parse(std::vector<const char*> args, griyn::SimOptions& options) {
+    args.insert(args.begin(), {"cache_sim", "trace"});
+    return griyn::parse_sim_options(args.size(), const_cast<char**>(args.data()), options);
+}
+
+static griyn::SimJob run(const std::vector<griyn::TraceRecord>& trace,
+        const char* policy, uint64_t param, double sample = 1) {
+    griyn::SimJob job {policy, param};
+    griyn::run_sim_job(trace, sample, job);
+    return job;
+}
+
+int main() {
+    // 参数检查
+    griyn::SimOptions options;
+    EXPECT_EQ(parse({}, options), true);
+    EXPECT_EQ(options.capacities.size(), 16);
+    EXPECT_EQ(options.capacities.front(), 1000);
+    EXPECT_EQ(options.capacities.back(), 10000000);
+
+    griyn::SimOptions custom;
+    EXPECT_EQ(parse({"--capacities=1,2", "--ttls=5", "--sample=0.5"}, custom), true);
+    EXPECT_EQ(custom.capacities.size(), 2);
+    EXPECT_EQ(custom.ttls.size(), 1);
+
+    griyn::SimOptions bad;
+    EXPECT_EQ(parse({"--steps=-1"}, bad), false);
+    EXPECT_EQ(parse({"--steps=0"}, bad), false);
+    EXPECT_EQ(parse({"--min=0"}, bad), false);
+    EXPECT_EQ(parse({"--min=10", "--max=5"}, bad), false);
+    EXPECT_EQ(parse({"--max=3000000000"}, bad), false); // 超过 int
+    EXPECT_EQ(parse({"--capacities=3000000000"}, bad), false);
+    EXPECT_EQ(parse({"--sample=0"}, bad), false);
+    EXPECT_EQ(parse({"--unknown=1"}, bad), false);
+
+    // 模拟两个线程的刷盘批次：文件中 t=3..5 的记录排在 t=0..2 之前
+    const std::string path = "/tmp/cache_sim_test.trace";
+    std::vector<griyn::TraceRecord> records = {
+        {3, 3, 0, griyn::TRACE_GET}, {4, 2, 0, griyn::TRACE_GET}, {5, 1, 0, griyn::TRACE_GET},
+        {0, 1, 0, griyn::TRACE_GET}, {1, 2, 0, griyn::TRACE_GET}, {2, 1, 0, griyn::TRACE_GET},
+    };
+    FILE* file = fopen(path.c_str(), "wb");
+    fwrite(griyn::TRACE_MAGIC, 1, sizeof(griyn::TRACE_MAGIC), file);
+    for (const auto& record : records) {
+        char buf[griyn::TRACE_RECORD_BYTES];
+        griyn::encode_trace_record(record, buf);
+        fwrite(buf, 1, sizeof(buf), file);
+    }
+    fclose(file);
+
+    std::vector<griyn::TraceRecord> trace;
+    griyn::TraceReader reader(path);
+    EXPECT_EQ(griyn::load_trace(reader, 1, trace), 6);
+    EXPECT_EQ(trace.size(), 6);
+    EXPECT_EQ(trace.front().timestamp_us, 0); // 按时间排序
+    EXPECT_EQ(trace.back().timestamp_us, 5);
+
+    // 按时间回放 1 2 1 3 2 1，容量 2
+    // LRU: 1 2 命中1 3(淘汰2) 2(淘汰1) 1
+    EXPECT_EQ(run(trace, "lru", 2).gets, 6);
+    EXPECT_EQ(run(trace, "lru", 2).misses, 5);
+    // FIFO: 1 2 命中1 3(淘汰1) 命中2 1
+    EXPECT_EQ(run(trace, "fifo", 2).misses, 4);
+    EXPECT_EQ(run(trace, "lru", 3).misses, 3); // 只有冷启动未命中
+    // 采样率 0.5 时容量按比例缩小
+    EXPECT_EQ(run(trace, "lru", 4, 0.5).misses, 5);
+
+    // SHARDS 采样率为 0 时全部过滤
+    std::vector<griyn::TraceRecord> sampled;
+    griyn::TraceReader sample_reader(path);
+    EXPECT_EQ(griyn::load_trace(sample_reader, 1e-9, sampled), 6);
+    EXPECT_EQ(sampled.size(), 0);
+
+    // expire: 写入后 1 秒过期，已存在的 key 不刷新写入时间
+    std::vector<griyn::TraceRecord> expire_trace = {
+        {0, 7, 0, griyn::TRACE_GET},       // 未命中，写入
+        {500000, 7, 0, griyn::TRACE_GET},  // 命中
+        {1000000, 7, 0, griyn::TRACE_GET}, // 过期，重新写入
+        {1200000, 8, 0, griyn::TRACE_PUT},
+        {1500000, 8, 0, griyn::TRACE_GET}, // 命中
+        {2500000, 7, 0, griyn::TRACE_GET}, // 过期
+    };
+    griyn::SimJob expire_job = run(expire_trace, "expire", 1);
+    EXPECT_EQ(expire_job.gets, 5);
+    EXPECT_EQ(expire_job.misses, 3);
+
+    return 0;
+}
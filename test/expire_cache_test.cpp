@@ -30,5 +30,14 @@ int main() {
     EXPECT_EQ(cache.size(), 0);
     EXPECT_EQ(cache.timeq_size(), 0);
 
+    // 析构时唤醒清理线程，不必等满一个清理间隔
+    auto start = std::chrono::steady_clock::now();
+    {
+        griyn::ExpireCache<uint32_t, std::string> slow_cache(60, -1, 30);
+        slow_cache.put(1, "Hello");
+    }
+    bool fast_destroy = std::chrono::steady_clock::now() - start < std::chrono::seconds(5);
+    EXPECT_EQ(fast_destroy, true);
+
     return 0;
 }
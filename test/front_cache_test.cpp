@@ -0,0 +1,101 @@
+#include <string>
+#include <thread>
+#include "test_tool.h"
+#include "lru_cache.h"
+#include "shard_table.h"
+#include "expire_cache.h"
+#include "front_cache.h"
+
+int main() {
+    LRUCache<int, std::string> lru(3);
+    griyn::FrontCache<int, std::string, LRUCache<int, std::string>> front(lru, 16);
+
+    std::string output;
+    EXPECT_EQ(front.get(1, output), false); // 两层都不存在
+
+    front.put(1, "Hello");
+    EXPECT_EQ(front.get(1, output), true); // 回填 L1
+    EXPECT_EQ(output, "Hello");
+
+    // 直接改共享层，不广播时 L1 在 max_stale_s 内仍返回旧值
+    lru.put(1, "World");
+    EXPECT_EQ(front.get(1, output), true);
+    EXPECT_EQ(output, "Hello");
+
+    // 超过 max_stale_s 后回源
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    EXPECT_EQ(front.get(1, output), true);
+    EXPECT_EQ(output, "World");
+
+    // 广播失效后立即回源
+    lru.put(1, "Again");
+    front.invalidate(1);
+    EXPECT_EQ(front.get(1, output), true);
+    EXPECT_EQ(output, "Again");
+
+    // 通过 FrontCache 写入，其他线程的 L1 同样失效
+    std::string other_output;
+    std::thread([&] { front.get(1, other_output); }).join();
+    EXPECT_EQ(other_output, "Again");
+    front.put(1, "Hi");
+    std::thread([&] { front.get(1, other_output); }).join();
+    EXPECT_EQ(other_output, "Hi");
+
+    // 通过 FrontCache 删除，其他线程的 L1 同样失效
+    ShardTable<int, std::string> shard(4);
+    griyn::FrontCache<int, std::string, ShardTable<int, std::string>> shard_front(shard, 16);
+    shard_front.put(1, "Hello");
+    bool other_found = false;
+    std::thread([&] { other_found = shard_front.get(1, other_output); }).join();
+    EXPECT_EQ(other_found, true);
+    EXPECT_EQ(shard_front.get(1, output), true); // 本线程也回填 L1
+    shard_front.erase(1);
+    std::thread([&] { other_found = shard_front.get(1, other_output); }).join();
+    EXPECT_EQ(other_found, false);
+    EXPECT_EQ(shard_front.get(1, output), false);
+
+    // 同一线程交替访问多个实例
+    EXPECT_EQ(front.get(1, output), true);
+    EXPECT_EQ(output, "Hi");
+    shard_front.put(2, "World");
+    EXPECT_EQ(shard_front.get(2, output), true);
+    EXPECT_EQ(output, "World");
+    EXPECT_EQ(front.get(1, output), true);
+    EXPECT_EQ(output, "Hi");
+
+    // 整体失效
+    lru.put(1, "Bye");
+    front.invalidate_all();
+    EXPECT_EQ(front.get(1, output), true);
+    EXPECT_EQ(output, "Bye");
+
+    // 实例析构后各线程 L1 中缓存的 value 被释放
+    LRUCache<int, std::shared_ptr<int>> ptr_lru(3);
+    std::shared_ptr<int> resource = std::make_shared<int>(1);
+    ptr_lru.put(1, resource);
+    {
+        griyn::FrontCache<int, std::shared_ptr<int>, LRUCache<int, std::shared_ptr<int>>>
+            ptr_front(ptr_lru, 16);
+        std::shared_ptr<int> ptr_output;
+        ptr_front.get(1, ptr_output);
+        std::thread([&] { std::shared_ptr<int> v; ptr_front.get(1, v); }).join();
+        ptr_output.reset();
+        EXPECT_EQ(resource.use_count(), 3); // resource + LRU + 主线程 L1，子线程 L1 已随线程退出
+    }
+    EXPECT_EQ(resource.use_count(), 2);
+
+    // 共享层过期时通过回调广播
+    griyn::ExpireCache<int, std::string> expire(2);
+    griyn::FrontCache<int, std::string, griyn::ExpireCache<int, std::string>> expire_front(expire);
+    expire.set_expire_listener([&](const int& key) { expire_front.invalidate(key); });
+
+    EXPECT_EQ(expire_front.put(2, "Hello"), true);
+    EXPECT_EQ(expire_front.put(2, "Hello"), false); // 返回值透传
+    EXPECT_EQ(expire_front.get(2, output), true);
+    EXPECT_EQ(output, "Hello");
+
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+    EXPECT_EQ(expire_front.get(2, output), false);
+
+    return 0;
+}
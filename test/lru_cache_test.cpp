@@ -17,5 +17,10 @@ int main() {
     lru.put("Maria", "9");
     EXPECT_EQ(lru.get("George", output), false);
 
+    // 无竞争时 try_get 与 get 一致
+    EXPECT_EQ(lru.try_get("Maria", output), 0);
+    EXPECT_EQ(output, "9");
+    EXPECT_EQ(lru.try_get("George", output), 1);
+
     return 0;
 }
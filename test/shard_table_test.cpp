@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+#include "test_tool.h"
+#include "shard_table.h"
+#include "expire_cache.h"
+
+int main() {
+    // 默认不开启 NUMA
+    ShardTable<int, std::string> table(4);
+    EXPECT_EQ(table.put(1, "Hello"), true);
+    EXPECT_EQ(table.put(1, "Hello"), false); // 添加重复key
+    std::string output;
+    EXPECT_EQ(table.get(1, output), true);
+    EXPECT_EQ(output, "Hello");
+    EXPECT_EQ(table.node_num(), 1);
+    EXPECT_EQ(table.node_of(1), 0);
+    EXPECT_EQ(table.numa_stats().size(), 0);
+
+    // 开启 NUMA，按 partitioner 选择 node
+    int partition_calls = 0;
+    NumaOption<int> option;
+    option.enable = true;
+    option.partitioner = [&](const int& key) { ++partition_calls; return key; };
+
+    ShardTable<int, std::string> numa_table(4, option);
+    int node_num = numa_table.node_num();
+    EXPECT_EQ(node_num, griyn::Numa::node_num());
+    // node id 可能不连续，分片按序号映射到实际 id
+    const std::vector<int>& nodes = griyn::Numa::nodes();
+    EXPECT_EQ(nodes.size(), (size_t)node_num);
+    bool ascending = std::is_sorted(nodes.begin(), nodes.end());
+    EXPECT_EQ(ascending, true);
+    EXPECT_EQ(numa_table.node_of(3), 3 % node_num);
+
+    // 数据从分片所属 node 的内存池分配，反复增删检查内存复用
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            numa_table.put(i, std::to_string(i));
+        }
+        EXPECT_EQ(numa_table.size(), 1000);
+        for (int i = 0; i < 1000; ++i) {
+            numa_table.erase(i);
+        }
+        EXPECT_EQ(numa_table.size(), 0);
+    }
+    bool partitioned = partition_calls > 0;
+    EXPECT_EQ(partitioned, true);
+
+    numa_table.put(1, "World");
+    EXPECT_EQ(numa_table.get(1, output), true);
+    EXPECT_EQ(output, "World");
+    EXPECT_EQ(numa_table.get(2, output), false);
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t access = 0;
+    for (const auto& stat : numa_table.numa_stats()) {
+        hits += stat.hits;
+        misses += stat.misses;
+        access += stat.local_access + stat.remote_access;
+    }
+    EXPECT_EQ(hits, 1);
+    EXPECT_EQ(misses, 1);
+    EXPECT_EQ(access, 6003); // 3000次put + 3000次erase + put + 2次get
+
+    // 各线程独立计数，线程退出后计数保留
+    for (int i = 0; i < 2; ++i) {
+        std::thread([&] { numa_table.get(1, output); }).join();
+    }
+    hits = 0;
+    for (const auto& stat : numa_table.numa_stats()) {
+        hits += stat.hits;
+    }
+    EXPECT_EQ(hits, 3);
+
+    // ExpireCache 每个 node 一个清理线程
+    NumaOption<int> expire_option;
+    expire_option.enable = true;
+    griyn::ExpireCache<int, std::string> cache(2, -1, 1, 4, expire_option);
+    EXPECT_EQ(cache.put(1, "Hello"), true);
+    EXPECT_EQ(cache.put(2, "World"), true);
+    EXPECT_EQ(cache.timeq_size(), 2);
+    EXPECT_EQ(cache.get(1, output), true);
+    EXPECT_EQ(cache.numa_stats().size(), (size_t)node_num);
+
+    std::this_thread::sleep_for(std::chrono::seconds(3)); // 过期
+    EXPECT_EQ(cache.get(1, output), false);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.timeq_size(), 0);
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <string>
+#include <thread>
+#include "test_tool.h"
+#include "trace_recorder.h"
+
+int main() {
+    const std::string path = "/tmp/trace_recorder_test.trace";
+
+    {
+        griyn::TraceRecorder recorder(path, 4, 3600 * 1000); // 不自动刷盘
+        EXPECT_EQ(recorder.ok(), true);
+
+        EXPECT_EQ(recorder.record(griyn::TRACE_PUT, 1, 10), true);
+        EXPECT_EQ(recorder.record(griyn::TRACE_GET, 1), true);
+        EXPECT_EQ(recorder.record_key(griyn::TRACE_GET, std::string("Hello")), true);
+        EXPECT_EQ(recorder.record(griyn::TRACE_ERASE, 1), true);
+        EXPECT_EQ(recorder.record(griyn::TRACE_GET, 2), false); // 缓冲已满，丢弃
+        EXPECT_EQ(recorder.dropped(), 1);
+
+        recorder.flush();
+        EXPECT_EQ(recorder.recorded(), 4);
+
+        // 其他线程写自己的缓冲，退出后缓冲排空并移除，丢弃计数保留
+        std::thread([&] {
+            for (int i = 0; i < 5; ++i) {
+                recorder.record(griyn::TRACE_GET, 3);
+            }
+        }).join();
+        recorder.flush();
+        EXPECT_EQ(recorder.recorded(), 8);
+        EXPECT_EQ(recorder.dropped(), 2);
+        recorder.flush();
+        EXPECT_EQ(recorder.dropped(), 2);
+
+        EXPECT_EQ(recorder.record(griyn::TRACE_GET, 4), true);
+    } // 析构时刷盘
+
+    griyn::TraceReader reader(path);
+    EXPECT_EQ(reader.ok(), true);
+
+    griyn::TraceRecord record;
+    EXPECT_EQ(reader.next(record), true);
+    EXPECT_EQ(record.op, griyn::TRACE_PUT);
+    EXPECT_EQ(record.key_hash, 1);
+    EXPECT_EQ(record.size, 10);
+    EXPECT_EQ(reader.next(record), true);
+    EXPECT_EQ(record.op, griyn::TRACE_GET);
+    EXPECT_EQ(reader.next(record), true);
+    EXPECT_EQ(record.key_hash, std::hash<std::string>()("Hello"));
+    EXPECT_EQ(reader.next(record), true);
+    EXPECT_EQ(record.op, griyn::TRACE_ERASE);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(reader.next(record), true);
+        EXPECT_EQ(record.key_hash, 3);
+    }
+    EXPECT_EQ(reader.next(record), true);
+    EXPECT_EQ(record.key_hash, 4);
+    EXPECT_EQ(reader.next(record), false); // 文件结束
+
+    // 同一线程先后使用多个 recorder，已析构 recorder 的缓冲被移除
+    for (int i = 0; i < 3; ++i) {
+        griyn::TraceRecorder temp(path, 4);
+        EXPECT_EQ(temp.record(griyn::TRACE_GET, i), true);
+    }
+
+    griyn::TraceReader bad_reader("/tmp/trace_recorder_test.not_exist");
+    EXPECT_EQ(bad_reader.ok(), false);
+
+    return 0;
+}